@@ -12,11 +12,13 @@
 #include <cinttypes>
 #include <fstream>
 #include <unistd.h>
+#include <cerrno>
 #include <ctime>
 #include <pthread.h>
 #include <mutex>
 #include <atomic>
 #include <queue>
+#include <unordered_set>
 #include "pcb_queue.h"
 
 #define PCB_SIZE 38
@@ -31,20 +33,60 @@ struct agingThreadArgs {
     int vectorIndex;
 };
 
+// Per processor counters reported when each processor thread exits, aligned to a
+// cache line so processors updating their own counters don't contend with each other
+struct alignas(64) schedStats {
+    long dispatches;
+    long requeues;
+    long burstUnits;
+    int quantum;
+    long completed;
+    long long schedNs;          // time in queue operations, sorts and scheduler locks
+    long long schedCpuNs;       // thread CPU time of the same, excluding time preempted
+    long long haltNs;           // time parked by load balancing halts
+    long long workNs;           // time spent executing bursts
+    long long workCpuNs;        // thread CPU time spent executing bursts
+    long long firstDispatchNs;
+    long long lastCompleteNs;
+    unsigned long long sink;    // compute kernel result so it can't be optimized away
+};
+
+// Streaming histogram of remaining burst times, older epochs are decayed
+// so the adaptive round robin quantum follows the current mix of jobs
+#define SKETCH_BUCKETS 256
+struct burstSketch {
+    float counts[SKETCH_BUCKETS];
+    float total;
+};
+
 int rrTimeQuantum = 2;
+
+// Nanoseconds of real compute per burst unit, 0 keeps the sleep based execution
+long long BURN_NS = 0;
+double burnItersPerNs = 0.0;
+
+// Adaptive round robin (arr) tuning, quantums are in burst units (10 units = 1 sec)
+int arrEpochLength = 8;             // dispatches between quantum resizes
+float arrTargetRequeueRate = 0.25;  // fraction of dispatches allowed to be requeued
+int arrMinQuantum = 10;
+int arrMaxQuantum = 100;            // response time bound on how long one PCB holds the processor
 int NUM_PROCESSORS;
 int NUM_PRIOR_PROCS;
 int NUM_PCBS;
 int SUSPEND_FLAG = 0;
-int IS_COMPLETE = 0;
+std::atomic<int> IS_COMPLETE(0);
 int TOTAL_PCB_MEMORY = 0;
 
 pthread_cond_t resumeCond;
 pthread_mutex_t mutexSuspend;
 pthread_mutex_t agingLock;
+pthread_mutex_t controlLock;
 std::vector<PCB*> pcbList;
+std::unordered_set<int> knownPids;
 std::vector<pcb_queue> procLoads;
-std::string argsErrMsg = "\nInvalid arguments! Usage:\n<executable> <# processors (n)> "
+std::vector<schedStats> procStats;
+std::vector<char *> scheduleType;
+std::string argsErrMsg = "\nInvalid arguments! Usage:\n<executable> [--<option> <value> ...] <# processors (n)> "
                         "<proc 1 %> ... <proc N %> <proc 1 type> ... <proc N type> <pcbFile.bin>\n";
 
 /*  
@@ -119,13 +161,14 @@ bool isValidArgs(int argc, char** argv) {
     }
 
     // Check for valid string combinations:
-    // sjf (shortest job first, rr (round robin), pr (priority), fcfs (first come first serve)
-    std::string schedOptions[] = {"sjf", "rr", "pr", "fcfs"};
+    // sjf (shortest job first, rr (round robin), arr (adaptive round robin),
+    // pr (priority), fcfs (first come first serve)
+    std::string schedOptions[] = {"sjf", "rr", "arr", "pr", "fcfs"};
     for (int i = (NUM_PROCESSORS +2); i < argc-1; i++) {
         
         std::string schedType = argv[i];
         bool covered = false;
-        for (int j = 0; j < 4; j++) {
+        for (int j = 0; j < 5; j++) {
             if (schedType == schedOptions[j])
                 covered = true;
         }
@@ -155,6 +198,47 @@ bool isValidArgs(int argc, char** argv) {
     return true;
 }
 
+// Consumes the optional "--<name> <value>" flags in front of the regular arguments
+bool parseOptions(int &argc, char** &argv) {
+    while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+        std::string option = argv[1];
+        char *value = argv[2];
+
+        if (option == "--burn") {
+            BURN_NS = strtoll(value, NULL, 10);
+            if (BURN_NS <= 0) {
+                printf("\nError: --burn needs a positive number of nanoseconds per burst unit\n");
+                return false;
+            }
+        }
+        else if (option == "--arr-epoch")
+            arrEpochLength = (int)strtol(value, NULL, 10);
+        else if (option == "--arr-target")
+            arrTargetRequeueRate = strtof(value, NULL);
+        else if (option == "--arr-min")
+            arrMinQuantum = (int)strtol(value, NULL, 10);
+        else if (option == "--arr-max")
+            arrMaxQuantum = (int)strtol(value, NULL, 10);
+        else {
+            printf("\nError: unknown option %s\n", argv[1]);
+            return false;
+        }
+
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
+    // The burst sketch clamps at SKETCH_BUCKETS - 1 so larger quantums could never be chosen
+    if (arrEpochLength < 1 || arrTargetRequeueRate <= 0.0 || arrTargetRequeueRate >= 1.0 ||
+        arrMinQuantum < 1 || arrMaxQuantum < arrMinQuantum || arrMaxQuantum >= SKETCH_BUCKETS) {
+        printf("\nError: adaptive round robin options need an epoch >= 1, a target rate between 0 and 1 "
+               "and 1 <= min quantum <= max quantum < %d\n", SKETCH_BUCKETS);
+        return false;
+    }
+    return true;
+}
+
 // Reads in 38 bytes from a file stream to create a PCB
 struct PCB* parsePCB(FILE *file) {
     struct PCB* pcb = (struct PCB*) malloc(sizeof(struct PCB));
@@ -216,16 +300,164 @@ void checkSuspend() {
     pthread_mutex_unlock(&mutexSuspend);
 }
 
+void sketchAdd(struct burstSketch *sketch, int burst) {
+    if (burst < 0)
+        burst = 0;
+    if (burst >= SKETCH_BUCKETS)
+        burst = SKETCH_BUCKETS - 1;
+    sketch->counts[burst] += 1.0;
+    sketch->total += 1.0;
+}
+
+// Halves every bucket so recent epochs outweigh older ones
+void sketchDecay(struct burstSketch *sketch) {
+    for (int i = 0; i < SKETCH_BUCKETS; i++)
+        sketch->counts[i] /= 2;
+    sketch->total /= 2;
+}
+
+// Returns the smallest burst time that at least the fraction q of observed bursts fit within
+int sketchQuantile(struct burstSketch *sketch, float q) {
+    float target = q * sketch->total;
+    float seen = 0.0;
+    for (int i = 0; i < SKETCH_BUCKETS; i++) {
+        seen += sketch->counts[i];
+        if (seen >= target)
+            return i;
+    }
+    return SKETCH_BUCKETS - 1;
+}
+
+long long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// CPU time used by the calling thread, unlike nowNs it stops while the thread is preempted
+long long threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Wall and thread CPU timestamps taken together so every timed section reports both
+struct timeStamp {
+    long long wallNs;
+    long long cpuNs;
+};
+
+struct timeStamp takeStamp() {
+    return timeStamp{nowNs(), threadCpuNs()};
+}
+
+// Xorshift loop used as the compute kernel, chained through each caller's sink so it can't be folded away
+unsigned long long burnKernel(long long iterations, unsigned long long seed) {
+    unsigned long long x = seed | 1;
+    for (long long i = 0; i < iterations; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+// Doubles the kernel length until one run takes at least 50ms to measure its speed
+void calibrateBurn() {
+    volatile unsigned long long sink = 1;
+    long long iterations = 1 << 16, elapsed = 0;
+    while (elapsed < 50000000) {
+        iterations *= 2;
+        long long start = nowNs();
+        sink = burnKernel(iterations, sink);
+        elapsed = nowNs() - start;
+    }
+    burnItersPerNs = (double)iterations / elapsed;
+}
+
+#define NS_PER_BURST_UNIT 100000000LL
+
+// Sleep used by sjf, pr and fcfs: whole seconds of the burst, or 1 second for an empty burst
+long long wholeSecondSleepNs(float secFormat) {
+    if (secFormat <= 0)
+        return 1000000000LL;
+    return (long long)secFormat * 1000000000LL;
+}
+
+// Executes one dispatch of a PCB, sleeping for sleepNs or burning BURN_NS of real
+// compute per burst unit when started with --burn
+void executeBurst(int loadIndex, int burstUnits, long long sleepNs) {
+    struct schedStats *stats = &procStats[loadIndex];
+    struct timeStamp start = takeStamp();
+    if (stats->firstDispatchNs == 0)
+        stats->firstDispatchNs = start.wallNs;
+
+    if (BURN_NS > 0)
+        stats->sink = burnKernel((long long)(burstUnits * BURN_NS * burnItersPerNs), stats->sink);
+    else {
+        struct timespec ts;
+        ts.tv_sec = sleepNs / 1000000000LL;
+        ts.tv_nsec = (long)(sleepNs % 1000000000LL);
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+    }
+
+    struct timeStamp end = takeStamp();
+    stats->lastCompleteNs = end.wallNs;
+    stats->workNs += end.wallNs - start.wallNs;
+    stats->workCpuNs += end.cpuNs - start.cpuNs;
+    stats->dispatches++;
+    stats->burstUnits += burstUnits;
+}
+
+// Charges the wall and CPU time since start to the processor's scheduling overhead
+void addSchedTime(int loadIndex, struct timeStamp start) {
+    struct timeStamp end = takeStamp();
+    procStats[loadIndex].schedNs += end.wallNs - start.wallNs;
+    procStats[loadIndex].schedCpuNs += end.cpuNs - start.cpuNs;
+}
+
+// Waits out any load balancing halt, timed apart from scheduling overhead
+void timedCheckSuspend(int loadIndex) {
+    long long start = nowNs();
+    checkSuspend();
+    procStats[loadIndex].haltNs += nowNs() - start;
+}
+
+// Pops the next PCB, counting the queue operation and its locks as scheduling overhead.
+// Returns nullptr if a cancel emptied the queue after the scheduler's empty() check
+struct PCB* timedPop(int loadIndex, bool agingLocked) {
+    struct timeStamp start = takeStamp();
+    if (agingLocked)
+        pthread_mutex_lock(&agingLock);
+    struct PCB *currPCB = procLoads[loadIndex].pop();
+    if (agingLocked)
+        pthread_mutex_unlock(&agingLock);
+    addSchedTime(loadIndex, start);
+    return currPCB;
+}
+
+void timedPush(int loadIndex, struct PCB *currPCB) {
+    struct timeStamp start = takeStamp();
+    procLoads[loadIndex].push(currPCB);
+    addSchedTime(loadIndex, start);
+}
+
 // Splits the load of PCB's for each processor's specified load percentage
 void allocateProcLoads(FILE * file, char** argv) {
     
     // Reading in the PCB's and storing into a vector
-    for (int i = 0; i < NUM_PCBS; i++)
+    for (int i = 0; i < NUM_PCBS; i++) {
         pcbList.push_back(parsePCB(file));
+        knownPids.insert(pcbList.back()->process_id);
+    }
     
-    // Creating load queues for each processor
-    for (int i = 0; i < NUM_PROCESSORS; i++)
-        procLoads.push_back(pcb_queue());
+    // Creating load queues and stat counters for each processor, the queues hold
+    // a mutex so they are constructed in place rather than copied in
+    procLoads = std::vector<pcb_queue>(NUM_PROCESSORS);
+    for (int i = 0; i < NUM_PROCESSORS; i++) {
+        procLoads[i].setId(i);
+        procStats.push_back(schedStats{0, 0, 0, rrTimeQuantum * 10, 0, 0, 0, 0, 0, 0, 0, 0, 1});
+    }
 
     // Splitting PCB's into load percentages for each processor
     float loadPercents[NUM_PROCESSORS];
@@ -271,7 +503,9 @@ void allocateProcLoads(FILE * file, char** argv) {
 void shortestJobFirst(int loadIndex) {
     
     // Sorts pcb_queue by shortest to longest jobs
+    struct timeStamp sortStart = takeStamp();
     procLoads[loadIndex].sortByBurst();
+    addSchedTime(loadIndex, sortStart);
 
     while(IS_COMPLETE != 1) {
 
@@ -282,21 +516,21 @@ void shortestJobFirst(int loadIndex) {
         }
 
         // Checks for signal that load balancer is not moving PCB's
-        checkSuspend();
+        timedCheckSuspend(loadIndex);
 
-        struct PCB *currPCB = procLoads[loadIndex].pop();
+        struct PCB *currPCB = timedPop(loadIndex, false);
+        if (currPCB == nullptr)
+            continue;
         printf("[Processor #%d] (SJF) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
 
         // Decreases burst time and sleeps for proportional time to burst_time
         float secFormat = (float)currPCB->burst_time / 10;
         printf("[Processor #%d] (SJF) Sleeping for %.2f secs...\n", loadIndex, secFormat);
+        int burstUnits = currPCB->burst_time;
         currPCB->burst_time = 0;
 
-        if (secFormat <= 0)
-            sleep(1);
-        else
-            sleep((int)secFormat);
-
+        executeBurst(loadIndex, burstUnits, wholeSecondSleepNs(secFormat));
+        procStats[loadIndex].completed++;
     }
 }
 
@@ -311,29 +545,101 @@ void roundRobin(int loadIndex) {
         }
 
         // Checks for signal that load balancer is not moving PCB's
-        checkSuspend();
+        timedCheckSuspend(loadIndex);
 
-        struct PCB *currPCB = procLoads[loadIndex].pop();
+        struct PCB *currPCB = timedPop(loadIndex, false);
+        if (currPCB == nullptr)
+            continue;
         printf("[Processor #%d] (RR) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
 
         // Simulates a round robin cycling after a given time quantum
-        if (currPCB->burst_time >= 20) {
-            currPCB->burst_time -= 20;
-            printf("[Processor #%d] (RR) processing for 2 seconds...\n", loadIndex);
-            sleep(rrTimeQuantum);
+        if (currPCB->burst_time >= rrTimeQuantum * 10) {
+            currPCB->burst_time -= rrTimeQuantum * 10;
+            printf("[Processor #%d] (RR) processing for %d seconds...\n", loadIndex, rrTimeQuantum);
+            executeBurst(loadIndex, rrTimeQuantum * 10, rrTimeQuantum * 10 * NS_PER_BURST_UNIT);
         }
 
         else {
             float secFormat = (float)currPCB->burst_time / 10;
+            int burstUnits = currPCB->burst_time;
             currPCB->burst_time = 0;
             printf("[Processor #%d] (RR) processing remaining burst time for %.2f seconds\n", loadIndex, secFormat);
-            sleep((int)secFormat);
+            executeBurst(loadIndex, burstUnits, burstUnits * NS_PER_BURST_UNIT);
         }
 
 
         if (currPCB->burst_time > 0) {
             printf("[Processor #%d] (RR) pushing PCB back to queue\n", loadIndex);
-            procLoads[loadIndex].push(currPCB);
+            timedPush(loadIndex, currPCB);
+            procStats[loadIndex].requeues++;
+        }
+        else
+            procStats[loadIndex].completed++;
+    }
+
+}
+
+// Round robin whose quantum is resized every epoch from the distribution of remaining
+// burst times so that only about arrTargetRequeueRate of dispatches get requeued
+void adaptiveRoundRobin(int loadIndex) {
+
+    struct burstSketch sketch;
+    memset(&sketch, 0, sizeof(sketch));
+    int quantum = procStats[loadIndex].quantum;
+    int epochDispatches = 0, epochRequeues = 0;
+
+    while(IS_COMPLETE != 1) {
+
+        // Waits to give loader a chance to assign more work
+        if (procLoads[loadIndex].empty()) {
+            sleep(2);
+            continue;
+        }
+
+        // Checks for signal that load balancer is not moving PCB's
+        timedCheckSuspend(loadIndex);
+
+        struct PCB *currPCB = timedPop(loadIndex, false);
+        if (currPCB == nullptr)
+            continue;
+        printf("[Processor #%d] (ARR) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
+
+        // Sketch updates and quantum resizes count as scheduling overhead
+        struct timeStamp sketchStart = takeStamp();
+        sketchAdd(&sketch, currPCB->burst_time);
+        int slice = (currPCB->burst_time > quantum) ? quantum : currPCB->burst_time;
+        addSchedTime(loadIndex, sketchStart);
+
+        currPCB->burst_time -= slice;
+        printf("[Processor #%d] (ARR) processing for %.2f seconds (quantum %d)\n", loadIndex, (float)slice / 10, quantum);
+        executeBurst(loadIndex, slice, slice * NS_PER_BURST_UNIT);
+        epochDispatches++;
+
+        if (currPCB->burst_time > 0) {
+            printf("[Processor #%d] (ARR) pushing PCB back to queue\n", loadIndex);
+            timedPush(loadIndex, currPCB);
+            procStats[loadIndex].requeues++;
+            epochRequeues++;
+        }
+        else
+            procStats[loadIndex].completed++;
+
+        // Resizes the quantum so the target fraction of remaining bursts finish within one slice
+        if (epochDispatches >= arrEpochLength) {
+            sketchStart = takeStamp();
+            quantum = sketchQuantile(&sketch, 1.0 - arrTargetRequeueRate);
+            if (quantum < arrMinQuantum)
+                quantum = arrMinQuantum;
+            if (quantum > arrMaxQuantum)
+                quantum = arrMaxQuantum;
+            sketchDecay(&sketch);
+            addSchedTime(loadIndex, sketchStart);
+
+            printf("[Processor #%d] (ARR) epoch requeue rate %.2f, quantum resized to %d burst units\n",
+                loadIndex, (float)epochRequeues / epochDispatches, quantum);
+            procStats[loadIndex].quantum = quantum;
+            epochDispatches = 0;
+            epochRequeues = 0;
         }
     }
 
@@ -342,7 +648,9 @@ void roundRobin(int loadIndex) {
 void prioritySchedule(int loadIndex) {
     
     // Initially sorts PCB's by the highest priority first to lowest priority
+    struct timeStamp sortStart = takeStamp();
     procLoads[loadIndex].sortByPriority();
+    addSchedTime(loadIndex, sortStart);
 
     // While the processor's job queue is non-empty will keep processing PCB's
     while(IS_COMPLETE != 1) {
@@ -354,24 +662,23 @@ void prioritySchedule(int loadIndex) {
         }
 
         // Checks for signal that load balancer is not moving PCB's
-        checkSuspend();
+        timedCheckSuspend(loadIndex);
 
-        pthread_mutex_lock(&agingLock);
-            struct PCB *currPCB = procLoads[loadIndex].pop();
-        pthread_mutex_unlock(&agingLock);
-            
-            printf("[Processor #%d] (Priority) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
+        // Aging lock keeps the aging thread from resorting while popping
+        struct PCB *currPCB = timedPop(loadIndex, true);
+        if (currPCB == nullptr)
+            continue;
 
-            // Decreases burst time and sleeps for proportional time to burst_time
-            float secFormat = (float)currPCB->burst_time / 10;
-            printf("[Processor #%d] (Priority) Sleeping for %.2f secs...\n", loadIndex, secFormat);
-            currPCB->burst_time = 0;
+        printf("[Processor #%d] (Priority) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
 
-        if (secFormat <= 0)
-            sleep(1);
-        else
-            sleep((int)secFormat);
+        // Decreases burst time and sleeps for proportional time to burst_time
+        float secFormat = (float)currPCB->burst_time / 10;
+        printf("[Processor #%d] (Priority) Sleeping for %.2f secs...\n", loadIndex, secFormat);
+        int burstUnits = currPCB->burst_time;
+        currPCB->burst_time = 0;
 
+        executeBurst(loadIndex, burstUnits, wholeSecondSleepNs(secFormat));
+        procStats[loadIndex].completed++;
     }
 }
 
@@ -386,21 +693,21 @@ void firstComeFirstServe(int loadIndex) {
         }
 
         // Checks for signal that load balancer is not moving PCB's
-        checkSuspend();
+        timedCheckSuspend(loadIndex);
 
-        struct PCB *currPCB = procLoads[loadIndex].pop();
+        struct PCB *currPCB = timedPop(loadIndex, false);
+        if (currPCB == nullptr)
+            continue;
         printf("[Processor #%d] (FCFS) Popped PCB off queue, PCB burst time: %d\n", loadIndex, currPCB->burst_time);
 
         // Decreases burst time and sleeps for proportional time to burst_time
         float secFormat = (float)currPCB->burst_time / 10;
         printf("[Processor #%d] (FCFS) Sleeping for %.2f secs...\n", loadIndex, secFormat);
 
+        int burstUnits = currPCB->burst_time;
         currPCB->burst_time = 0;
-        if (secFormat <= 0)
-            sleep(1);
-        else
-            sleep((int)secFormat);
-
+        executeBurst(loadIndex, burstUnits, wholeSecondSleepNs(secFormat));
+        procStats[loadIndex].completed++;
     }
 
 }
@@ -460,14 +767,142 @@ void * processorThread(void * args) {
     else if (schedType == "rr")
         roundRobin(t_arg->loaderIndex);
 
+    else if (schedType == "arr")
+        adaptiveRoundRobin(t_arg->loaderIndex);
+
     else if (schedType == "pr") {
         prioritySchedule(t_arg->loaderIndex);
     }
 
+    // Reports the context switches and measured execution time round robin processors used
+    if (schedType == "rr" || schedType == "arr") {
+        struct schedStats *stats = &procStats[t_arg->loaderIndex];
+        printf("\n[Processor #%d] (%s) %ld dispatches, %ld requeues, %ld burst units executed in %.2f secs, final quantum %d burst units\n",
+            t_arg->loaderIndex, (schedType == "rr") ? "RR" : "ARR", stats->dispatches, stats->requeues,
+            stats->burstUnits, (double)stats->workNs / 1e9, stats->quantum);
+    }
+
     printf("\n~~~ [PROCESSOR #%d] now exiting ~~~\n", t_arg->loaderIndex);
     return nullptr;
 }
 
+// Returns the processor whose queue currently holds the PCB, or -1 if it is running or finished
+int findProcessor(int pid) {
+    return pcb_queue::locate(pid);
+}
+
+// Applies one command line read from the command channel. The shared process_id index finds
+// the PCB's queue in O(1) and that queue's own index finds its slot in O(1). Changes to pr/sjf
+// queues binary search the PCB's sorted spot and only renumber the shorter side of it
+void runCommand(char *line) {
+    char cmd[16];
+    int pid = 0, priority = 0, target = 0, burst = 0;
+    if (sscanf(line, "%15s", cmd) != 1)
+        return;
+
+    std::string command = cmd;
+    if (command == "where" && sscanf(line, "%*s %d", &pid) == 1) {
+        int loadIndex = findProcessor(pid);
+        if (loadIndex < 0)
+            printf("[Command] PCB %d is not waiting on any queue\n", pid);
+        else
+            printf("[Command] PCB %d is at position %d on [Processor #%d]\n", pid,
+                procLoads[loadIndex].position(pid), loadIndex);
+    }
+
+    else if (command == "prio" && sscanf(line, "%*s %d %d", &pid, &priority) == 2) {
+        if (priority < INT8_MIN || priority > INT8_MAX) {
+            printf("[Command] priority must be between %d and %d\n", INT8_MIN, INT8_MAX);
+            return;
+        }
+        int loadIndex = findProcessor(pid);
+        bool updated = false;
+        if (loadIndex >= 0) {
+            std::string currType = scheduleType.at(loadIndex);
+            if (currType == "pr")
+                updated = procLoads[loadIndex].repositionByPriority(pid, (int8_t)priority);
+            else
+                updated = procLoads[loadIndex].setPriority(pid, (int8_t)priority);
+        }
+        if (! updated) {
+            printf("[Command] PCB %d is not waiting on any queue\n", pid);
+            return;
+        }
+        printf("[Command] PCB %d on [Processor #%d] now has priority %d\n", pid, loadIndex, priority);
+    }
+
+    else if (command == "cancel" && sscanf(line, "%*s %d", &pid) == 1) {
+        int loadIndex = findProcessor(pid);
+        struct PCB *pcb = (loadIndex < 0) ? nullptr : procLoads[loadIndex].remove(pid);
+        if (pcb == nullptr) {
+            printf("[Command] PCB %d is not waiting on any queue\n", pid);
+            return;
+        }
+        pcb->burst_time = 0;
+        printf("[Command] PCB %d cancelled on [Processor #%d]\n", pid, loadIndex);
+    }
+
+    else if (command == "inject" && sscanf(line, "%*s %d %d %d %d", &target, &pid, &priority, &burst) == 4) {
+        if (target < 0 || target >= NUM_PROCESSORS || burst <= 0 || priority < INT8_MIN || priority > INT8_MAX) {
+            printf("[Command] inject needs a valid processor number, a positive burst time and a priority "
+                   "between %d and %d\n", INT8_MIN, INT8_MAX);
+            return;
+        }
+
+        // Rejects any pid ever loaded or injected, queued, running or finished
+        if (knownPids.count(pid) != 0) {
+            printf("[Command] PCB %d already exists\n", pid);
+            return;
+        }
+
+        struct PCB* pcb = (struct PCB*) malloc(sizeof(struct PCB));
+        if (pcb == nullptr)
+            return;
+        memset(pcb, 0, sizeof(struct PCB));
+        strcpy(pcb->process_name, "injected");
+        pcb->process_id = pid;
+        pcb->priority = (int8_t)priority;
+        pcb->activity_status = 1;
+        pcb->burst_time = burst;
+
+        knownPids.insert(pid);
+        pcbList.push_back(pcb);
+        std::string currType = scheduleType.at(target);
+        if (currType == "pr")
+            procLoads[target].insertSorted(pcb, pcb_queue::comparePriority);
+        else if (currType == "sjf")
+            procLoads[target].insertSorted(pcb, pcb_queue::compareBurst);
+        else
+            procLoads[target].push(pcb);
+        printf("[Command] PCB %d injected into [Processor #%d]\n", pid, target);
+    }
+
+    else {
+        printf("[Command] Unknown command, usage: where <pid> | prio <pid> <priority> | "
+               "cancel <pid> | inject <processor> <pid> <priority> <burst>\n");
+    }
+    fflush(stdout);
+}
+
+// Reads commands from stdin while the simulation runs. The queues lock themselves, controlLock
+// keeps commands from overlapping a load balance or running once main starts freeing PCB's,
+// and agingLock keeps them from changing a priority queue while it is aged or popped
+void * commandThread(void *) {
+    char line[128];
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        pthread_mutex_lock(&controlLock);
+        if (IS_COMPLETE == 1) {
+            pthread_mutex_unlock(&controlLock);
+            break;
+        }
+        pthread_mutex_lock(&agingLock);
+            runCommand(line);
+        pthread_mutex_unlock(&agingLock);
+        pthread_mutex_unlock(&controlLock);
+    }
+    return nullptr;
+}
+
 bool loadBalance(int loadIndex) {
 
     int max = 0, target = 0;
@@ -485,6 +920,9 @@ bool loadBalance(int loadIndex) {
     if (procLoads[target].size() <= 5)
         return false;
 
+    // Keeps runtime commands from editing queues while PCB's are moved
+    pthread_mutex_lock(&controlLock);
+
     // Signal a halt of execution to all other threads to prevent interference
     // when moving loads and wait for them to finish their current jobs
     suspendThreads();
@@ -493,6 +931,7 @@ bool loadBalance(int loadIndex) {
     printf("\n[ ------------------------------------------------------------------------------------ ]\n");
     printf("[Load Balancing] Calculating the processor with the most jobs and reallocating half...\n");
 
+    pthread_mutex_lock(&agingLock);
     int split = procLoads[target].size() / 2;
     for (int i = 0; i < split; i++) {
         struct PCB* currPCB = procLoads[target].pop();
@@ -500,16 +939,27 @@ bool loadBalance(int loadIndex) {
         if (currPCB != nullptr)
             procLoads[loadIndex].push(currPCB);
     }
+    pthread_mutex_unlock(&agingLock);
 
     printf("[Load Balancing] Complete: [Processor #%d] has taken %d PCB's from [Processor #%d]", loadIndex, split, target);
     printf("\n[ ------------------------------------------------------------------------------------ ]\n\n");
     resumeThreads();
+    pthread_mutex_unlock(&controlLock);
     return true;
 }
 
 
 int main(int argc, char** argv) {
 
+    if (! parseOptions(argc, argv))
+        return -1;
+
+    if (BURN_NS > 0) {
+        calibrateBurn();
+        printf("\nCPU bound mode: %lld ns of compute per burst unit (%.3f kernel iterations per ns)\n",
+            BURN_NS, burnItersPerNs);
+    }
+
     if (! isValidArgs(argc, argv))
         return -1;
     
@@ -536,7 +986,6 @@ int main(int argc, char** argv) {
 
     // Prepares the schedule type to be passed to each thread and tracks
     // the number of processors with a priority scheduling type
-    std::vector<char *> scheduleType;
     NUM_PRIOR_PROCS = 0;
     for (int i = (NUM_PROCESSORS +2), j = 0; i < argc-1; i++, j++) {
         scheduleType.push_back(argv[i]);
@@ -565,9 +1014,11 @@ int main(int argc, char** argv) {
     // Initializes condition variable for load balancing and mutex locks
     pthread_mutex_init(&mutexSuspend, NULL);
     pthread_mutex_init(&agingLock, NULL);
+    pthread_mutex_init(&controlLock, NULL);
     pthread_cond_init(&resumeCond, NULL);
 
     // Creating threads for the number of processors specified
+    long long runStart = nowNs();
     pthread_t processors[NUM_PROCESSORS];
     for (int i = 0; i < NUM_PROCESSORS; i++)
         pthread_create(&processors[i], NULL, processorThread, &t_args[i]);
@@ -575,6 +1026,11 @@ int main(int argc, char** argv) {
     pthread_t agingThreads[NUM_PRIOR_PROCS];
     for (int i = 0; i < NUM_PRIOR_PROCS; i++)
         pthread_create(&agingThreads[i], NULL, agingThread, (void*)&priorityIndices[i]);
+
+    // Command thread is detached as it may stay blocked on stdin after all processors finish
+    pthread_t cmdThread;
+    pthread_create(&cmdThread, NULL, commandThread, NULL);
+    pthread_detach(cmdThread);
     
     
     // Main thread loop which checks if all processors are done and load balances
@@ -593,8 +1049,11 @@ int main(int argc, char** argv) {
         }
     }
 
-    // Signals threads to wrap up as all processor jobs have been completed
+    // Signals threads to wrap up as all processor jobs have been completed, taking
+    // controlLock waits out any command in progress and later commands see IS_COMPLETE and stop
+    pthread_mutex_lock(&controlLock);
     IS_COMPLETE = 1;
+    pthread_mutex_unlock(&controlLock);
     printf("\nAll processors have completed processing their allocated PCB's\n");
 
     for (int i = 0; i < NUM_PROCESSORS; i++)
@@ -603,8 +1062,49 @@ int main(int argc, char** argv) {
     for (int i = 0; i < NUM_PRIOR_PROCS; i++)
         pthread_join(agingThreads[i], NULL);
 
+    // Reports throughput over each processor's active span, from its first dispatch to its last
+    // completion, and the share of its time spent on scheduling overhead (queue operations, sorts
+    // and scheduler locks) rather than executing bursts. Load balancing halts are listed separately.
+    // Work and overhead are shown in wall and thread CPU time, the share uses CPU time in cpu bound
+    // mode so preemption on a saturated machine isn't charged to whichever section it lands in
+    double wallSecs = (double)(nowNs() - runStart) / 1e9;
+    long totalCompleted = 0, totalUnits = 0;
+    long long runFirst = 0, runLast = 0;
+    printf("\n[ ------------------------------------------------------------------------------------ ]\n");
+    printf("Execution summary (%s mode, %.2f secs wall time)\n", (BURN_NS > 0) ? "cpu bound" : "sleep", wallSecs);
+    for (int i = 0; i < NUM_PROCESSORS; i++) {
+        struct schedStats *stats = &procStats[i];
+        double activeSecs = (double)(stats->lastCompleteNs - stats->firstDispatchNs) / 1e9;
+        long long workShare = (BURN_NS > 0) ? stats->workCpuNs : stats->workNs;
+        long long schedShare = (BURN_NS > 0) ? stats->schedCpuNs : stats->schedNs;
+        double overheadPct = (workShare + schedShare > 0) ? 100.0 * schedShare / (double)(workShare + schedShare) : 0.0;
+
+        printf("[Processor #%d] (%s) %ld PCB's completed, %.1f burst units/sec over %.3f active secs\n",
+               i, scheduleType.at(i), stats->completed, (activeSecs > 0) ? stats->burstUnits / activeSecs : 0.0,
+               activeSecs);
+        printf("    work %.3f secs (%.3f cpu), scheduling overhead %.6f secs (%.6f cpu), overhead share %.3f%% "
+               "of %s time, load balancing halts %.3f secs\n",
+               (double)stats->workNs / 1e9, (double)stats->workCpuNs / 1e9, (double)stats->schedNs / 1e9,
+               (double)stats->schedCpuNs / 1e9, overheadPct, (BURN_NS > 0) ? "cpu" : "wall", (double)stats->haltNs / 1e9);
+
+        totalCompleted += stats->completed;
+        totalUnits += stats->burstUnits;
+        if (stats->dispatches > 0) {
+            if (runFirst == 0 || stats->firstDispatchNs < runFirst)
+                runFirst = stats->firstDispatchNs;
+            if (stats->lastCompleteNs > runLast)
+                runLast = stats->lastCompleteNs;
+        }
+    }
+
+    double runSecs = (double)(runLast - runFirst) / 1e9;
+    if (runSecs > 0)
+        printf("Throughput: %.2f PCB's/sec, %.1f burst units/sec over %.3f secs from first dispatch to last completion\n",
+            totalCompleted / runSecs, totalUnits / runSecs, runSecs);
+    printf("[ ------------------------------------------------------------------------------------ ]\n\n");
+
     // [ ----- Deallocations ----- ]
-    for (int i = 0; i < NUM_PCBS; i++)
+    for (int i = 0; i < (int)pcbList.size(); i++)
         free(pcbList[i]);
 
     free(t_args);
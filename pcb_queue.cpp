@@ -1,30 +1,219 @@
 #include "pcb_queue.h"
 
-pcb_queue::pcb_queue() {}
-pcb_queue::~pcb_queue() {}
+std::unordered_map<int, int> pcb_queue::owner_index;
+pthread_mutex_t pcb_queue::owner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+pcb_queue::pcb_queue() : head_seq(0), holes(0), queue_id(-1) {
+    pthread_mutex_init(&q_lock, NULL);
+}
+
+pcb_queue::~pcb_queue() {
+    pthread_mutex_destroy(&q_lock);
+}
+
+void pcb_queue::setId(int id) {
+    queue_id = id;
+}
+
+// Returns the id of the queue currently holding the PCB, -1 if it is running, finished or unknown
+int pcb_queue::locate(int pid) {
+    pthread_mutex_lock(&owner_lock);
+        auto it = owner_index.find(pid);
+        int id = (it == owner_index.end()) ? -1 : it->second;
+    pthread_mutex_unlock(&owner_lock);
+    return id;
+}
+
+void pcb_queue::claim(int pid) {
+    pthread_mutex_lock(&owner_lock);
+        owner_index[pid] = queue_id;
+    pthread_mutex_unlock(&owner_lock);
+}
+
+void pcb_queue::release(int pid) {
+    pthread_mutex_lock(&owner_lock);
+        owner_index.erase(pid);
+    pthread_mutex_unlock(&owner_lock);
+}
+
+// Drops the holes left by remove and renumbers the remaining slots, caller holds q_lock
+void pcb_queue::compact() {
+    if (holes == 0)
+        return;
+    p_queue.erase(std::remove(p_queue.begin(), p_queue.end(), nullptr), p_queue.end());
+    holes = 0;
+    reindex();
+}
+
+// Rebuilds the process_id index from scratch, caller holds q_lock
+void pcb_queue::reindex() {
+    pid_index.clear();
+    for (int i = 0; i < (int)p_queue.size(); i++)
+        pid_index[p_queue[i]->process_id] = head_seq + i;
+}
+
+// Inserts at pos of a queue without holes, caller holds q_lock. Inserting in the front half
+// moves head_seq back so only the entries before pos change, otherwise only those after it
+void pcb_queue::insertAt(int pos, PCB *elem) {
+    if (pos < (int)p_queue.size() / 2) {
+        for (int i = 0; i < pos; i++)
+            pid_index[p_queue[i]->process_id]--;
+        head_seq--;
+    }
+    else {
+        for (int i = pos; i < (int)p_queue.size(); i++)
+            pid_index[p_queue[i]->process_id]++;
+    }
+    p_queue.insert(p_queue.begin() + pos, elem);
+    pid_index[elem->process_id] = head_seq + pos;
+}
+
+// Erases pos from a queue without holes, caller holds q_lock, renumbering the shorter side like insertAt
+void pcb_queue::eraseAt(int pos) {
+    if (pos < (int)p_queue.size() / 2) {
+        for (int i = 0; i < pos; i++)
+            pid_index[p_queue[i]->process_id]++;
+        head_seq++;
+    }
+    else {
+        for (int i = pos + 1; i < (int)p_queue.size(); i++)
+            pid_index[p_queue[i]->process_id]--;
+    }
+    pid_index.erase(p_queue[pos]->process_id);
+    p_queue.erase(p_queue.begin() + pos);
+}
+
+// Returns the PCB's offset from the front of the queue including any holes, caller holds q_lock
+int pcb_queue::slot(int pid) {
+    auto it = pid_index.find(pid);
+    if (it == pid_index.end())
+        return -1;
+    return (int)(it->second - head_seq);
+}
 
 PCB* pcb_queue::at(int index) {
-    return p_queue.at(index);
+    pthread_mutex_lock(&q_lock);
+        compact();
+        struct PCB *elem = p_queue.at(index);
+    pthread_mutex_unlock(&q_lock);
+    return elem;
 }
 
 bool pcb_queue::empty() {
-    return p_queue.empty();
+    return size() == 0;
 }
 
 int pcb_queue::size(){
-    return (int)p_queue.size();
+    pthread_mutex_lock(&q_lock);
+        int count = (int)p_queue.size() - holes;
+    pthread_mutex_unlock(&q_lock);
+    return count;
 }
 
 void pcb_queue::push(PCB *elem) {
-    p_queue.push_back(elem);
+    pthread_mutex_lock(&q_lock);
+        pid_index[elem->process_id] = head_seq + (long)p_queue.size();
+        p_queue.push_back(elem);
+        claim(elem->process_id);
+    pthread_mutex_unlock(&q_lock);
 }
 
 PCB* pcb_queue::pop() {
-    struct PCB *elem = p_queue.front();
-    p_queue.pop_front();
+    struct PCB *elem = nullptr;
+    pthread_mutex_lock(&q_lock);
+        while (! p_queue.empty() && p_queue.front() == nullptr) {
+            p_queue.pop_front();
+            head_seq++;
+            holes--;
+        }
+        if (! p_queue.empty()) {
+            elem = p_queue.front();
+            p_queue.pop_front();
+            head_seq++;
+            pid_index.erase(elem->process_id);
+            release(elem->process_id);
+        }
+    pthread_mutex_unlock(&q_lock);
+    return elem;
+}
+
+bool pcb_queue::contains(int pid) {
+    pthread_mutex_lock(&q_lock);
+        bool found = pid_index.count(pid) != 0;
+    pthread_mutex_unlock(&q_lock);
+    return found;
+}
+
+PCB* pcb_queue::find(int pid) {
+    struct PCB *elem = nullptr;
+    pthread_mutex_lock(&q_lock);
+        int pos = slot(pid);
+        if (pos >= 0)
+            elem = p_queue[pos];
+    pthread_mutex_unlock(&q_lock);
+    return elem;
+}
+
+// Returns the PCB's offset from the front of the queue, -1 if absent. Holes left by
+// cancels are compacted first so they aren't counted as PCB's ahead of it
+int pcb_queue::position(int pid) {
+    pthread_mutex_lock(&q_lock);
+        compact();
+        int pos = slot(pid);
+    pthread_mutex_unlock(&q_lock);
+    return pos;
+}
+
+// Changes a queued PCB's priority, returns false if it is no longer on this queue
+bool pcb_queue::setPriority(int pid, int8_t priority) {
+    pthread_mutex_lock(&q_lock);
+        int pos = slot(pid);
+        if (pos >= 0)
+            p_queue[pos]->priority = priority;
+    pthread_mutex_unlock(&q_lock);
+    return pos >= 0;
+}
+
+PCB* pcb_queue::remove(int pid) {
+    struct PCB *elem = nullptr;
+    pthread_mutex_lock(&q_lock);
+        int pos = slot(pid);
+        if (pos >= 0) {
+            elem = p_queue[pos];
+            p_queue[pos] = nullptr;
+            pid_index.erase(pid);
+            release(pid);
+            holes++;
+        }
+    pthread_mutex_unlock(&q_lock);
     return elem;
 }
 
+void pcb_queue::insertSorted(PCB *elem, bool (*compare)(const PCB*, const PCB*)) {
+    pthread_mutex_lock(&q_lock);
+        compact();
+        int pos = (int)(std::upper_bound(p_queue.begin(), p_queue.end(), elem, compare) - p_queue.begin());
+        insertAt(pos, elem);
+        claim(elem->process_id);
+    pthread_mutex_unlock(&q_lock);
+}
+
+// Moves a queued PCB to its new spot in a queue sorted by priority, false if it is no longer queued
+bool pcb_queue::repositionByPriority(int pid, int8_t priority) {
+    pthread_mutex_lock(&q_lock);
+        compact();
+        int pos = slot(pid);
+        if (pos >= 0) {
+            struct PCB *elem = p_queue[pos];
+            eraseAt(pos);
+            elem->priority = priority;
+            int newPos = (int)(std::upper_bound(p_queue.begin(), p_queue.end(), elem, comparePriority) - p_queue.begin());
+            insertAt(newPos, elem);
+        }
+    pthread_mutex_unlock(&q_lock);
+    return pos >= 0;
+}
+
 // Comparators for different sorts needed for schedulers
 bool pcb_queue::comparePID(const PCB* pcb1, const PCB* pcb2) {
     return pcb1->process_id < pcb2->process_id;
@@ -39,13 +228,25 @@ bool pcb_queue::comparePriority(const PCB* pcb1, const PCB* pcb2) {
 }
 
 void pcb_queue::sortByPID() {
-    std::sort(p_queue.begin(), p_queue.end(), comparePID);
+    pthread_mutex_lock(&q_lock);
+        compact();
+        std::sort(p_queue.begin(), p_queue.end(), comparePID);
+        reindex();
+    pthread_mutex_unlock(&q_lock);
 }
 
 void pcb_queue::sortByBurst() {
-    std::sort(p_queue.begin(), p_queue.end(), compareBurst);
+    pthread_mutex_lock(&q_lock);
+        compact();
+        std::sort(p_queue.begin(), p_queue.end(), compareBurst);
+        reindex();
+    pthread_mutex_unlock(&q_lock);
 }
 
 void pcb_queue::sortByPriority() {
-    std::sort(p_queue.begin(), p_queue.end(), comparePriority);
-}
\ No newline at end of file
+    pthread_mutex_lock(&q_lock);
+        compact();
+        std::sort(p_queue.begin(), p_queue.end(), comparePriority);
+        reindex();
+    pthread_mutex_unlock(&q_lock);
+}
@@ -2,6 +2,8 @@
 #define PCB_QUEUE_H
 
 #include <deque>
+#include <pthread.h>
+#include <unordered_map>
 #include <algorithm>
 #include <cstdio>
 #include <cstdlib>
@@ -24,10 +26,40 @@ class pcb_queue {
 
     std::deque<PCB *> p_queue;
 
+    // Every public member takes q_lock so processors, the load balancer and
+    // the command thread can all use the same queue safely
+    pthread_mutex_t q_lock;
+
+    // Maps a process_id to its slot as an absolute sequence number, the slot's
+    // position in p_queue is (sequence - head_seq). Removed PCB's leave a nullptr
+    // hole which is skipped by pop and cleared out by compact
+    std::unordered_map<int, long> pid_index;
+    long head_seq;
+    int holes;
+    int queue_id;
+
+    // Maps every queued process_id to the id of the queue holding it, shared by all
+    // queues. owner_lock is only ever taken while already holding a q_lock or alone
+    static std::unordered_map<int, int> owner_index;
+    static pthread_mutex_t owner_lock;
+
+    void compact();
+    void reindex();
+    int slot(int pid);
+    void insertAt(int pos, PCB *elem);
+    void eraseAt(int pos);
+    void claim(int pid);
+    void release(int pid);
+
     public:
 
         pcb_queue();
         ~pcb_queue();
+        pcb_queue(const pcb_queue&) = delete;
+        pcb_queue& operator=(const pcb_queue&) = delete;
+
+        void setId(int id);
+        static int locate(int pid);
 
         PCB* at(int index);
         bool empty();
@@ -35,12 +67,25 @@ class pcb_queue {
         void push(PCB *elem);
         PCB* pop();
 
+        // Constant time lookups, updates and removal by process_id
+        bool contains(int pid);
+        PCB* find(int pid);
+        int position(int pid);
+        bool setPriority(int pid, int8_t priority);
+        PCB* remove(int pid);
+
+        // Keeps an already sorted queue sorted with a binary search for the new spot,
+        // renumbering only the index entries on the shorter side of it
+        void insertSorted(PCB *elem, bool (*compare)(const PCB*, const PCB*));
+        bool repositionByPriority(int pid, int8_t priority);
+
         // Comparators for different sorts needed for schedulers
         static bool comparePID(const PCB* pcb1, const PCB* pcb2);
         static bool compareBurst(const PCB* pcb1, const PCB* pcb2);
         static bool comparePriority(const PCB* pcb1, const PCB* pcb2);
 
-        // Sorts needed for Fcfs, Sjf, and Priority
+        // Sorts needed for Fcfs, Sjf, and Priority, these also rebuild the process_id
+        // index so they cost O(n log n)
         void sortByPID();
         void sortByBurst();
         void sortByPriority();